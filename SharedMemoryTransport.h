@@ -0,0 +1,275 @@
+#ifndef SHAREDMEMORYTRANSPORT_H
+#define SHAREDMEMORYTRANSPORT_H
+
+#include "SharedState.h"
+#include "WireCodec.h"
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+// Shared-memory transport for clients on the same machine as the server.
+//
+// Each room gets a named file mapping holding:
+//   - the room's GameState behind a seqlock: the server is the only writer,
+//     and any number of local processes can read a consistent snapshot
+//     without a system call or a lock
+//   - one single-producer/single-consumer move ring per player slot, which
+//     the client in that slot fills and the server drains
+//
+// A client that pushes into a ring the server found empty signals the
+// server's wake event, so moves are applied as soon as they land instead of
+// on the server's next timeout.
+//
+// Joining still goes over TCP, and the socket stays open so the server
+// notices when the client leaves.
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "shared-memory atomics must be lock-free");
+
+// Identifies a valid, initialized region (bump the layout version on changes)
+const uint32_t SHARED_ROOM_MAGIC = 0x44534D52; // "DSMR"
+const uint32_t SHARED_ROOM_LAYOUT = 2;
+
+// Moves a client can queue before the server drains them; power of two
+const uint32_t SHARED_RING_CAPACITY = 64;
+
+// Result of taking a move from a ring. Any local process can write to the
+// region, so the server treats ring contents as untrusted input.
+enum SharedPopResult {
+    SHARED_RING_EMPTY,
+    SHARED_RING_MOVE,
+    SHARED_RING_STALE,   // Left by the slot's previous owner; skip it
+    SHARED_RING_CORRUPT  // Indexes or entry are impossible; drop the client
+};
+
+// SharedMoveEntry - a move stamped with the slot generation it was queued
+// under, so moves from a client that lost its slot can't reach the next owner
+struct SharedMoveEntry {
+    uint32_t generation;
+    MoveMessage move;
+};
+
+// SharedMoveRing - SPSC queue of moves from one player slot.
+// Kept on its own cache line so clients in different slots don't contend.
+struct alignas(64) SharedMoveRing {
+    std::atomic<uint32_t> head; // Next entry the client writes
+    std::atomic<uint32_t> tail; // Next entry the server reads
+    std::atomic<uint32_t> serverWaiting; // Server found the ring empty; next push wakes it
+    std::atomic<uint32_t> generation;    // Set by the server each time the slot changes hands
+    SharedMoveEntry entries[SHARED_RING_CAPACITY];
+};
+
+// SharedRoomRegion - layout of one room's mapping
+struct SharedRoomRegion {
+    std::atomic<uint32_t> magic;
+    uint32_t layout;
+
+    // Seqlock sequence: odd while the server is writing, bumped by 2 per update
+    alignas(64) std::atomic<uint32_t> stateSeq;
+    GameState state;
+
+    SharedMoveRing moveRings[4];
+};
+
+// Mapping names include the port so servers on different ports don't collide
+inline void sharedRoomName(char* out, size_t size, int port, int roomId) {
+    snprintf(out, size, "Local\\DSMGame_%d_Room_%d", port, roomId);
+}
+
+// One auto-reset wake event per server, shared by all its rooms: the server
+// waits on it next to its sockets, and WSAWaitForMultipleEvents() can only
+// wait on 64 handles, far fewer than the rooms it hosts
+inline void sharedWakeName(char* out, size_t size, int port) {
+    snprintf(out, size, "Local\\DSMGame_%d_Wake", port);
+}
+
+// SharedRoomMapping - owns a process's view of one room's region
+class SharedRoomMapping {
+private:
+    HANDLE mapping;
+    SharedRoomRegion* region;
+    HANDLE wakeEvent; // Client side only; the server owns its event
+
+    SharedRoomMapping(const SharedRoomMapping&) = delete;
+    SharedRoomMapping& operator=(const SharedRoomMapping&) = delete;
+
+    bool mapView() {
+        void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(SharedRoomRegion));
+        if (!view) {
+            CloseHandle(mapping);
+            mapping = NULL;
+            return false;
+        }
+        region = static_cast<SharedRoomRegion*>(view);
+        return true;
+    }
+
+public:
+    SharedRoomMapping() : mapping(NULL), region(nullptr), wakeEvent(NULL) {}
+
+    // Server side: create (or take over) the region and initialize it
+    bool create(const char* name, const GameState& initialState) {
+        mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+                                     0, sizeof(SharedRoomRegion), name);
+        if (!mapping || !mapView()) {
+            return false;
+        }
+
+        // Construct the atomics in place, then publish the magic last so
+        // clients never see a half-initialized region
+        new (region) SharedRoomRegion();
+        region->layout = SHARED_ROOM_LAYOUT;
+        region->stateSeq.store(0, std::memory_order_relaxed);
+        memcpy(&region->state, &initialState, sizeof(GameState));
+        for (int i = 0; i < 4; i++) {
+            resetMoveRing(i, 0);
+        }
+        region->magic.store(SHARED_ROOM_MAGIC, std::memory_order_release);
+        return true;
+    }
+
+    // Client side: attach to a region the server already created, and to
+    // the server's wake event
+    bool open(const char* name, const char* wakeName) {
+        mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+        if (!mapping || !mapView()) {
+            return false;
+        }
+        wakeEvent = OpenEventA(EVENT_MODIFY_STATE, FALSE, wakeName);
+        if (!wakeEvent ||
+            region->magic.load(std::memory_order_acquire) != SHARED_ROOM_MAGIC ||
+            region->layout != SHARED_ROOM_LAYOUT) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (wakeEvent) {
+            CloseHandle(wakeEvent);
+            wakeEvent = NULL;
+        }
+        if (region) {
+            UnmapViewOfFile(region);
+            region = nullptr;
+        }
+        if (mapping) {
+            CloseHandle(mapping);
+            mapping = NULL;
+        }
+    }
+
+    // Server: publish a new snapshot (single writer)
+    void publishState(const GameState& state) {
+        uint32_t seq = region->stateSeq.load(std::memory_order_relaxed);
+        region->stateSeq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        memcpy(&region->state, &state, sizeof(GameState));
+
+        region->stateSeq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Reader: copy the snapshot if it changed since lastSeq.
+    // Returns false if nothing new was read; gives up after a few retries
+    // rather than spinning behind a writer.
+    bool readState(GameState& out, uint32_t& lastSeq) const {
+        for (int attempt = 0; attempt < 64; attempt++) {
+            uint32_t before = region->stateSeq.load(std::memory_order_acquire);
+            if (before == lastSeq) {
+                return false;
+            }
+            if (before & 1) {
+                continue; // Server is mid-write
+            }
+
+            memcpy(&out, &region->state, sizeof(GameState));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (region->stateSeq.load(std::memory_order_relaxed) == before) {
+                lastSeq = before;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Server: empty a slot's ring before handing the slot to a new player
+    void resetMoveRing(int slot, uint32_t generation) {
+        region->moveRings[slot].head.store(0, std::memory_order_relaxed);
+        region->moveRings[slot].serverWaiting.store(1, std::memory_order_relaxed);
+        region->moveRings[slot].generation.store(generation, std::memory_order_relaxed);
+        region->moveRings[slot].tail.store(0, std::memory_order_release);
+    }
+
+    // Client: the generation to stamp on moves, read once after joining
+    uint32_t moveRingGeneration(int slot) const {
+        return region->moveRings[slot].generation.load(std::memory_order_acquire);
+    }
+
+    // Client: queue a move; returns false if the ring is full.
+    // Signals the server only when it has found this ring empty since the
+    // last signal, so a burst of moves costs one system call.
+    bool pushMove(int slot, uint32_t generation, const MoveMessage& move) {
+        SharedMoveRing& ring = region->moveRings[slot];
+        uint32_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.tail.load(std::memory_order_acquire) == SHARED_RING_CAPACITY) {
+            return false;
+        }
+        ring.entries[head % SHARED_RING_CAPACITY].generation = generation;
+        ring.entries[head % SHARED_RING_CAPACITY].move = move;
+
+        // Sequentially consistent, paired with popMove(): either the server
+        // sees the new head or this push sees its waiting flag
+        ring.head.store(head + 1, std::memory_order_seq_cst);
+        if (ring.serverWaiting.exchange(0, std::memory_order_seq_cst) != 0) {
+            SetEvent(wakeEvent);
+        }
+        return true;
+    }
+
+    // Server: take the oldest queued move, copied out before it is checked
+    // so the client can't change it afterwards. The ring is FIFO, so a move
+    // from the slot's current owner must carry exactly expectedSeq.
+    SharedPopResult popMove(int slot, uint32_t generation, uint32_t expectedSeq, MoveMessage& move) {
+        SharedMoveRing& ring = region->moveRings[slot];
+        uint32_t tail = ring.tail.load(std::memory_order_relaxed);
+        uint32_t head = ring.head.load(std::memory_order_acquire);
+        if (tail == head) {
+            // Ask the next push to wake us, then look again in case one
+            // landed before the flag was visible
+            ring.serverWaiting.store(1, std::memory_order_seq_cst);
+            head = ring.head.load(std::memory_order_seq_cst);
+            if (tail == head) {
+                return SHARED_RING_EMPTY;
+            }
+        }
+        if (head - tail > SHARED_RING_CAPACITY) {
+            return SHARED_RING_CORRUPT;
+        }
+
+        SharedMoveEntry entry = ring.entries[tail % SHARED_RING_CAPACITY];
+        ring.tail.store(tail + 1, std::memory_order_release);
+
+        if (entry.generation != generation) {
+            return SHARED_RING_STALE;
+        }
+        move = entry.move;
+
+        // Same step limits wireDecodeMove applies to moves from the socket
+        if (move.seq != expectedSeq ||
+            move.dx < -1 || move.dx > 1 || move.dy < -1 || move.dy > 1) {
+            return SHARED_RING_CORRUPT;
+        }
+        return SHARED_RING_MOVE;
+    }
+
+    ~SharedRoomMapping() {
+        close();
+    }
+};
+
+#endif // SHAREDMEMORYTRANSPORT_H
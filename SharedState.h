@@ -27,8 +27,23 @@ struct GameState {
     Player players[4];
 };
 
+// JoinRequest - first message a client sends after connecting
+struct JoinRequest {
+    // Room to join, or -1 to let the server pick a room with a free slot
+    int32_t roomId;
+};
+
+// JoinReply - server's answer to a JoinRequest, sent before the first GameState
+struct JoinReply {
+    int32_t roomId;
+    int32_t playerId;
+};
+
 #pragma pack(pop)
 
+// Let the server pick a room for the client
+const int32_t AUTO_ASSIGN_ROOM = -1;
+
 // Maze layout constants
 const char MAZE_LAYOUT[10][10] = {
     {'+', '-', '-', '-', '-', '-', '-', '-', '-', '+'},
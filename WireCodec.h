@@ -0,0 +1,412 @@
+#ifndef WIRECODEC_H
+#define WIRECODEC_H
+
+#include "SharedState.h"
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+// Compact, versioned binary wire format shared by client and server.
+//
+// Every message travels as a frame:
+//   [payload length: varint] [header: version << 4 | type] [body]
+//
+// Multi-byte integers are LEB128 varints and packed fields are written
+// LSB-first into bytes, so the encoding does not depend on host endianness
+// or struct packing.
+
+// Wire format version, carried in the high nibble of every header byte
+const uint8_t WIRE_VERSION = 1;
+
+enum WireMessageType {
+    WIRE_JOIN_REQUEST = 1,
+    WIRE_JOIN_REPLY = 2,
+    WIRE_MOVE = 3,
+    WIRE_STATE = 4,
+    WIRE_ATTACH_SHARED = 5  // Client switched to the room's shared-memory region
+};
+
+// Grid and player dimensions derived from GameState
+const int WIRE_GRID_HEIGHT = sizeof(GameState::grid) / sizeof(GameState::grid[0]);
+const int WIRE_GRID_WIDTH = sizeof(GameState::grid[0]);
+const int WIRE_MAX_PLAYERS = sizeof(GameState::players) / sizeof(Player);
+
+// Smallest number of bits that can hold values 0..count-1
+constexpr int wireBitsFor(int count, int bits = 0) {
+    return (1 << bits) >= count ? bits : wireBitsFor(count, bits + 1);
+}
+
+// Grid cells are sent as indexes into this table
+const char WIRE_CELL_CHARS[] = { ' ', '#', '+', '-', '|' };
+const int WIRE_CELL_KINDS = sizeof(WIRE_CELL_CHARS);
+const int WIRE_CELL_BITS = wireBitsFor(WIRE_CELL_KINDS);
+
+// Index of a cell character in WIRE_CELL_CHARS, or -1 if it has no encoding
+inline int wireCellCode(char cell) {
+    switch (cell) {
+        case ' ': return 0;
+        case '#': return 1;
+        case '+': return 2;
+        case '-': return 3;
+        case '|': return 4;
+        default:  return -1;
+    }
+}
+
+// Coordinates are quantized to the grid: 4 bits each for a 10x10 maze
+const int WIRE_X_BITS = wireBitsFor(WIRE_GRID_WIDTH);
+const int WIRE_Y_BITS = wireBitsFor(WIRE_GRID_HEIGHT);
+
+const size_t WIRE_GRID_BYTES = (WIRE_GRID_WIDTH * WIRE_GRID_HEIGHT * WIRE_CELL_BITS + 7) / 8;
+const size_t WIRE_MAX_VARINT = 5;
+
+// Largest possible payload: header, flags, grid, ids and coordinates
+const size_t WIRE_MAX_PAYLOAD = 1 + 1 + WIRE_GRID_BYTES
+    + WIRE_MAX_PLAYERS * WIRE_MAX_VARINT
+    + (WIRE_MAX_PLAYERS * (WIRE_X_BITS + WIRE_Y_BITS) + 7) / 8;
+
+// Encode buffer size; also an upper bound on any frame's length
+const size_t WIRE_MAX_FRAME = WIRE_MAX_VARINT + WIRE_MAX_PAYLOAD;
+
+// MoveMessage - a unit step plus a client-assigned sequence number
+struct MoveMessage {
+    int32_t dx;
+    int32_t dy;
+    uint32_t seq;
+};
+
+// WireFrame - a decoded view into a receive buffer; no bytes are copied
+struct WireFrame {
+    WireMessageType type;
+    const uint8_t* body;
+    size_t bodyLength;
+};
+
+// ---- Varints ----------------------------------------------------------
+
+inline size_t wireWriteVarint(uint8_t* out, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+// Returns bytes read, or 0 if the varint is truncated or too long
+inline size_t wireReadVarint(const uint8_t* in, size_t len, uint32_t& value) {
+    value = 0;
+    for (size_t n = 0; n < len && n < WIRE_MAX_VARINT; n++) {
+        value |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+        if (!(in[n] & 0x80)) {
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+// Zigzag maps small negative numbers to small varints (-1 -> 1, 1 -> 2)
+inline uint32_t wireZigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+inline int32_t wireUnzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+// ---- Bit packing -------------------------------------------------------
+
+// Writes fields LSB-first; bytes are zeroed as they are first touched
+struct WireBitWriter {
+    uint8_t* out;
+    size_t bitPos;
+
+    explicit WireBitWriter(uint8_t* buffer) : out(buffer), bitPos(0) {}
+
+    void write(uint32_t value, int bits) {
+        while (bits > 0) {
+            int offset = (int)(bitPos % 8);
+            if (offset == 0) {
+                out[bitPos / 8] = 0;
+            }
+            int take = bits < 8 - offset ? bits : 8 - offset;
+            out[bitPos / 8] |= (uint8_t)((value & ((1u << take) - 1)) << offset);
+            value >>= take;
+            bits -= take;
+            bitPos += take;
+        }
+    }
+
+    size_t bytesUsed() const {
+        return (bitPos + 7) / 8;
+    }
+};
+
+struct WireBitReader {
+    const uint8_t* in;
+    size_t bitPos;
+
+    explicit WireBitReader(const uint8_t* buffer) : in(buffer), bitPos(0) {}
+
+    uint32_t read(int bits) {
+        uint32_t value = 0;
+        int shift = 0;
+        while (shift < bits) {
+            int offset = (int)(bitPos % 8);
+            int take = bits - shift < 8 - offset ? bits - shift : 8 - offset;
+            value |= (uint32_t)((in[bitPos / 8] >> offset) & ((1u << take) - 1)) << shift;
+            shift += take;
+            bitPos += take;
+        }
+        return value;
+    }
+};
+
+// ---- Framing -----------------------------------------------------------
+
+// Wrap a body already written at out + WIRE_MAX_VARINT + 1 into a frame at out.
+// Returns the total frame length.
+inline size_t wireFinishFrame(uint8_t* out, WireMessageType type, size_t bodyLength) {
+    uint8_t prefix[WIRE_MAX_VARINT];
+    size_t prefixLength = wireWriteVarint(prefix, (uint32_t)(bodyLength + 1));
+
+    // Slide the header and body down so they directly follow the length prefix
+    uint8_t* header = out + prefixLength;
+    memmove(header + 1, out + WIRE_MAX_VARINT + 1, bodyLength);
+    header[0] = (uint8_t)((WIRE_VERSION << 4) | type);
+    memcpy(out, prefix, prefixLength);
+    return prefixLength + 1 + bodyLength;
+}
+
+// Parse one frame from the front of a receive buffer.
+// Returns bytes consumed (> 0), 0 if more bytes are needed, or -1 if the
+// frame is malformed or from another protocol version.
+inline int wireDecodeFrame(const uint8_t* buf, size_t len, WireFrame& frame) {
+    uint32_t payloadLength;
+    size_t prefixLength = wireReadVarint(buf, len, payloadLength);
+    if (prefixLength == 0) {
+        return len >= WIRE_MAX_VARINT ? -1 : 0;
+    }
+    if (payloadLength == 0 || payloadLength > WIRE_MAX_PAYLOAD) {
+        return -1;
+    }
+    if (len < prefixLength + payloadLength) {
+        return 0;
+    }
+
+    uint8_t header = buf[prefixLength];
+    int type = header & 0x0F;
+    if ((header >> 4) != WIRE_VERSION || type < WIRE_JOIN_REQUEST || type > WIRE_ATTACH_SHARED) {
+        return -1;
+    }
+
+    frame.type = (WireMessageType)type;
+    frame.body = buf + prefixLength + 1;
+    frame.bodyLength = payloadLength - 1;
+    return (int)(prefixLength + payloadLength);
+}
+
+// ---- Messages ----------------------------------------------------------
+// Encoders write into a buffer of at least WIRE_MAX_FRAME bytes and return
+// the frame length, or 0 if the message cannot be represented.
+// Decoders return false on a malformed body.
+
+inline size_t wireEncodeJoinRequest(uint8_t* out, const JoinRequest& req) {
+    uint8_t* body = out + WIRE_MAX_VARINT + 1;
+    size_t n = wireWriteVarint(body, wireZigzag(req.roomId));
+    return wireFinishFrame(out, WIRE_JOIN_REQUEST, n);
+}
+
+inline bool wireDecodeJoinRequest(const WireFrame& frame, JoinRequest& req) {
+    uint32_t roomId;
+    size_t n = wireReadVarint(frame.body, frame.bodyLength, roomId);
+    if (n == 0 || n != frame.bodyLength) {
+        return false;
+    }
+    req.roomId = wireUnzigzag(roomId);
+    return true;
+}
+
+inline size_t wireEncodeJoinReply(uint8_t* out, const JoinReply& reply) {
+    if (reply.roomId < 0 || reply.playerId < 0) {
+        return 0;
+    }
+    uint8_t* body = out + WIRE_MAX_VARINT + 1;
+    size_t n = wireWriteVarint(body, (uint32_t)reply.roomId);
+    n += wireWriteVarint(body + n, (uint32_t)reply.playerId);
+    return wireFinishFrame(out, WIRE_JOIN_REPLY, n);
+}
+
+inline bool wireDecodeJoinReply(const WireFrame& frame, JoinReply& reply) {
+    uint32_t roomId, playerId;
+    size_t n = wireReadVarint(frame.body, frame.bodyLength, roomId);
+    if (n == 0) {
+        return false;
+    }
+    size_t m = wireReadVarint(frame.body + n, frame.bodyLength - n, playerId);
+    if (m == 0 || n + m != frame.bodyLength || roomId > INT32_MAX || playerId > INT32_MAX) {
+        return false;
+    }
+    reply.roomId = (int32_t)roomId;
+    reply.playerId = (int32_t)playerId;
+    return true;
+}
+
+// Attach has no body; the server already knows the client's room and slot
+inline size_t wireEncodeAttachShared(uint8_t* out) {
+    return wireFinishFrame(out, WIRE_ATTACH_SHARED, 0);
+}
+
+// Move body: [direction nibble] [sequence varint]
+// The direction is (dy + 1) * 3 + (dx + 1), covering every unit step.
+inline size_t wireEncodeMove(uint8_t* out, const MoveMessage& move) {
+    if (move.dx < -1 || move.dx > 1 || move.dy < -1 || move.dy > 1) {
+        return 0;
+    }
+    uint8_t* body = out + WIRE_MAX_VARINT + 1;
+    body[0] = (uint8_t)((move.dy + 1) * 3 + (move.dx + 1));
+    size_t n = 1 + wireWriteVarint(body + 1, move.seq);
+    return wireFinishFrame(out, WIRE_MOVE, n);
+}
+
+inline bool wireDecodeMove(const WireFrame& frame, MoveMessage& move) {
+    if (frame.bodyLength < 2 || frame.body[0] > 8) {
+        return false;
+    }
+    uint32_t seq;
+    if (wireReadVarint(frame.body + 1, frame.bodyLength - 1, seq) != frame.bodyLength - 1) {
+        return false;
+    }
+    move.dx = frame.body[0] % 3 - 1;
+    move.dy = frame.body[0] / 3 - 1;
+    move.seq = seq;
+    return true;
+}
+
+// State body:
+//   [flags: bit 7 = grid included, bits 0-3 = active player mask]
+//   [grid: WIRE_CELL_BITS per cell, only if flagged]
+//   [id varint per active player]
+//   [x, y bit-packed per active player]
+// Inactive players are not sent. The grid never changes during a game, so
+// servers only need to include it in the first snapshot a client receives.
+inline size_t wireEncodeState(uint8_t* out, const GameState& state, bool includeGrid) {
+    uint8_t* body = out + WIRE_MAX_VARINT + 1;
+    size_t n = 1;
+
+    uint8_t activeMask = 0;
+    for (int i = 0; i < WIRE_MAX_PLAYERS; i++) {
+        if (state.players[i].isActive) {
+            activeMask |= (uint8_t)(1 << i);
+        }
+    }
+    body[0] = (uint8_t)((includeGrid ? 0x80 : 0) | activeMask);
+
+    if (includeGrid) {
+        WireBitWriter cells(body + n);
+        for (int y = 0; y < WIRE_GRID_HEIGHT; y++) {
+            for (int x = 0; x < WIRE_GRID_WIDTH; x++) {
+                int kind = wireCellCode(state.grid[y][x]);
+                if (kind < 0) {
+                    return 0;
+                }
+                cells.write((uint32_t)kind, WIRE_CELL_BITS);
+            }
+        }
+        n += cells.bytesUsed();
+    }
+
+    for (int i = 0; i < WIRE_MAX_PLAYERS; i++) {
+        if (activeMask & (1 << i)) {
+            if (state.players[i].id < 0) {
+                return 0;
+            }
+            n += wireWriteVarint(body + n, (uint32_t)state.players[i].id);
+        }
+    }
+
+    WireBitWriter coords(body + n);
+    for (int i = 0; i < WIRE_MAX_PLAYERS; i++) {
+        if (activeMask & (1 << i)) {
+            const Player& p = state.players[i];
+            if (p.x < 0 || p.x >= WIRE_GRID_WIDTH || p.y < 0 || p.y >= WIRE_GRID_HEIGHT) {
+                return 0;
+            }
+            coords.write((uint32_t)p.x, WIRE_X_BITS);
+            coords.write((uint32_t)p.y, WIRE_Y_BITS);
+        }
+    }
+    n += coords.bytesUsed();
+
+    return wireFinishFrame(out, WIRE_STATE, n);
+}
+
+// Decodes into state in place. If the frame carries no grid, state.grid is
+// left untouched so the caller's cached maze is kept.
+inline bool wireDecodeState(const WireFrame& frame, GameState& state) {
+    const uint8_t* body = frame.body;
+    size_t len = frame.bodyLength;
+    if (len < 1 || (body[0] & 0x70)) {
+        return false;
+    }
+
+    bool hasGrid = (body[0] & 0x80) != 0;
+    uint8_t activeMask = body[0] & 0x0F;
+    size_t n = 1;
+
+    if (hasGrid) {
+        if (len < n + WIRE_GRID_BYTES) {
+            return false;
+        }
+        WireBitReader cells(body + n);
+        for (int y = 0; y < WIRE_GRID_HEIGHT; y++) {
+            for (int x = 0; x < WIRE_GRID_WIDTH; x++) {
+                uint32_t kind = cells.read(WIRE_CELL_BITS);
+                if (kind >= (uint32_t)WIRE_CELL_KINDS) {
+                    return false;
+                }
+                state.grid[y][x] = WIRE_CELL_CHARS[kind];
+            }
+        }
+        n += WIRE_GRID_BYTES;
+    }
+
+    int activeCount = 0;
+    for (int i = 0; i < WIRE_MAX_PLAYERS; i++) {
+        if (activeMask & (1 << i)) {
+            uint32_t id;
+            size_t m = wireReadVarint(body + n, len - n, id);
+            if (m == 0 || id > INT32_MAX) {
+                return false;
+            }
+            state.players[i].id = (int32_t)id;
+            n += m;
+            activeCount++;
+        } else {
+            state.players[i].id = -1;
+            state.players[i].x = 0;
+            state.players[i].y = 0;
+        }
+        state.players[i].isActive = (activeMask & (1 << i)) != 0;
+    }
+
+    if (len != n + (activeCount * (WIRE_X_BITS + WIRE_Y_BITS) + 7) / 8) {
+        return false;
+    }
+    WireBitReader coords(body + n);
+    for (int i = 0; i < WIRE_MAX_PLAYERS; i++) {
+        if (activeMask & (1 << i)) {
+            int x = (int)coords.read(WIRE_X_BITS);
+            int y = (int)coords.read(WIRE_Y_BITS);
+            if (x >= WIRE_GRID_WIDTH || y >= WIRE_GRID_HEIGHT) {
+                return false;
+            }
+            state.players[i].x = x;
+            state.players[i].y = y;
+        }
+    }
+    return true;
+}
+
+#endif // WIRECODEC_H
@@ -0,0 +1,156 @@
+// Wire codec benchmark: bytes per message and encode/decode throughput,
+// compared against the raw packed structs the protocol used to send.
+#include "SharedState.h"
+#include "WireCodec.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+// The previous wire format: host-endian struct dumps
+#pragma pack(push, 1)
+struct LegacyMoveRequest {
+    int32_t playerId;
+    int32_t dx;
+    int32_t dy;
+};
+#pragma pack(pop)
+
+// Keeps the optimizer from discarding benchmark loops
+static volatile uint32_t sink;
+
+static GameState makeSampleState(int activePlayers) {
+    GameState state;
+    for (int i = 0; i < 10; i++) {
+        for (int j = 0; j < 10; j++) {
+            state.grid[i][j] = MAZE_LAYOUT[i][j];
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        state.players[i].id = i < activePlayers ? i : -1;
+        state.players[i].x = 1 + i * 2;
+        state.players[i].y = 1 + i;
+        state.players[i].isActive = i < activePlayers;
+    }
+    return state;
+}
+
+static void printSize(const char* name, size_t legacyBytes, size_t wireBytes) {
+    std::cout << "  " << std::left << std::setw(34) << name
+              << std::right << std::setw(6) << legacyBytes
+              << std::setw(8) << wireBytes
+              << std::setw(9) << std::fixed << std::setprecision(1)
+              << (double)legacyBytes / wireBytes << "x" << std::endl;
+}
+
+template <typename Fn>
+static void runBenchmark(const char* name, long iterations, size_t bytesPerOp, Fn op) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        op(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double opsPerSec = iterations / seconds;
+    std::cout << "  " << std::left << std::setw(34) << name
+              << std::right << std::setw(8) << std::fixed << std::setprecision(2)
+              << opsPerSec / 1e6 << " M msg/s"
+              << std::setw(10) << (opsPerSec * bytesPerOp) / 1e6 << " MB/s" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 5000000;
+
+    GameState full = makeSampleState(4);
+    GameState single = makeSampleState(1);
+    uint8_t frame[WIRE_MAX_FRAME];
+
+    MoveMessage move = { 1, 0, 1 };
+    size_t moveSmall = wireEncodeMove(frame, move);
+    move.seq = 100000;
+    size_t moveLarge = wireEncodeMove(frame, move);
+    size_t stateGrid = wireEncodeState(frame, full, true);
+    size_t statePlayers = wireEncodeState(frame, full, false);
+    size_t stateSingle = wireEncodeState(frame, single, false);
+
+    std::cout << "Bytes per message (legacy struct vs wire codec v" << (int)WIRE_VERSION << ")" << std::endl;
+    std::cout << "  " << std::left << std::setw(34) << "message"
+              << std::right << std::setw(6) << "legacy" << std::setw(8) << "wire"
+              << std::setw(10) << "ratio" << std::endl;
+    printSize("move (seq < 128)", sizeof(LegacyMoveRequest), moveSmall);
+    printSize("move (seq = 100000)", sizeof(LegacyMoveRequest), moveLarge);
+    printSize("state, 4 players + maze", sizeof(GameState), stateGrid);
+    printSize("state, 4 players", sizeof(GameState), statePlayers);
+    printSize("state, 1 player", sizeof(GameState), stateSingle);
+    std::cout << std::endl;
+
+    std::cout << "Throughput (" << iterations << " iterations)" << std::endl;
+
+    runBenchmark("legacy move memcpy", iterations, sizeof(LegacyMoveRequest), [&](long i) {
+        LegacyMoveRequest req = { 0, (int32_t)(i & 1), 0 };
+        memcpy(frame, &req, sizeof(req));
+        sink += frame[4];
+    });
+
+    // Keep seq below 128 so every frame is moveSmall bytes and MB/s is exact
+    runBenchmark("move encode", iterations, moveSmall, [&](long i) {
+        MoveMessage m = { (int32_t)(i & 1), 0, (uint32_t)(i & 0x7F) };
+        sink += (uint32_t)wireEncodeMove(frame, m);
+    });
+
+    move.seq = 42;
+    size_t moveLength = wireEncodeMove(frame, move);
+    runBenchmark("move decode", iterations, moveLength, [&](long) {
+        WireFrame f = WireFrame();
+        MoveMessage m = MoveMessage();
+        wireDecodeFrame(frame, moveLength, f);
+        wireDecodeMove(f, m);
+        sink += m.seq;
+    });
+
+    GameState copy;
+    runBenchmark("legacy state memcpy", iterations, sizeof(GameState), [&](long i) {
+        full.players[0].x = 1 + (int)(i & 1);
+        memcpy(&copy, &full, sizeof(GameState));
+        sink += copy.players[0].x;
+    });
+
+    runBenchmark("state encode (players)", iterations, statePlayers, [&](long i) {
+        full.players[0].x = 1 + (int)(i & 1);
+        sink += (uint32_t)wireEncodeState(frame, full, false);
+    });
+
+    runBenchmark("state encode (with maze)", iterations / 10, stateGrid, [&](long) {
+        sink += (uint32_t)wireEncodeState(frame, full, true);
+    });
+
+    size_t stateLength = wireEncodeState(frame, full, false);
+    runBenchmark("state decode (players)", iterations, stateLength, [&](long) {
+        WireFrame f = WireFrame();
+        wireDecodeFrame(frame, stateLength, f);
+        wireDecodeState(f, copy);
+        sink += copy.players[3].y;
+    });
+
+    stateLength = wireEncodeState(frame, full, true);
+    runBenchmark("state decode (with maze)", iterations / 10, stateLength, [&](long) {
+        WireFrame f = WireFrame();
+        wireDecodeFrame(frame, stateLength, f);
+        wireDecodeState(f, copy);
+        sink += copy.players[3].y;
+    });
+
+    // Round-trip check so a broken codec can't report good numbers
+    WireFrame f = WireFrame();
+    GameState decoded;
+    stateLength = wireEncodeState(frame, full, true);
+    if (wireDecodeFrame(frame, stateLength, f) != (int)stateLength || !wireDecodeState(f, decoded) ||
+        memcmp(decoded.grid, full.grid, sizeof(full.grid)) != 0 ||
+        decoded.players[2].x != full.players[2].x || decoded.players[2].y != full.players[2].y) {
+        std::cerr << "Round-trip mismatch" << std::endl;
+        return 1;
+    }
+    return 0;
+}
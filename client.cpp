@@ -1,4 +1,5 @@
 #include "SharedState.h"
+#include "WireCodec.h"
 #include <iostream>
 
 // Minimize included Windows headers and keep winsock2 before windows.h to avoid winsock.h conflicts
@@ -7,8 +8,12 @@
 #include <windows.h>
 #include <ws2tcpip.h>
 #include <conio.h>
+#include "SharedMemoryTransport.h"
 #include <vector>
+#include <deque>
+#include <memory>
 #include <cstring>
+#include <cstdlib>
 #include <stdexcept>
 
 
@@ -25,7 +30,29 @@ private:
     GameState localState;
     GameState predictedState;
     int myPlayerId;
+    int myRoomId;
     ConsistencyMode mode;
+    uint32_t nextMoveSeq;
+
+    // Bytes received but not yet decoded (at most one partial frame between reads)
+    uint8_t rxBuffer[2 * WIRE_MAX_FRAME];
+    size_t rxLength;
+    bool haveState;
+
+    // Set when the server is on this machine and shared memory is in use
+    std::unique_ptr<SharedRoomMapping> sharedRoom;
+    uint32_t lastSharedSeq;
+    int mySlot;
+    uint32_t myRingGeneration; // Stamped on every move so the server knows it's ours
+
+    // Moves waiting for room in the shared ring, oldest first
+    std::deque<MoveMessage> sharedOverflow;
+
+    // Shared-memory mode never reads the socket for state, so check it for
+    // a server hang-up every SOCKET_CHECK_INTERVAL syncs instead
+    static const int SOCKET_CHECK_INTERVAL = 30; // ~0.5s at 60 FPS
+    int syncsSinceSocketCheck;
+    bool connected;
     
     // For Release mode: buffer of pending moves
     struct Move {
@@ -68,19 +95,129 @@ private:
         return true;
     }
 
+    void sendFrame(const uint8_t* frame, size_t length) {
+        send(serverSocket, (const char*)frame, (int)length, 0);
+    }
+
     void sendMoveToServer(int dx, int dy) {
-        struct MoveRequest {
-            int32_t playerId;
-            int32_t dx;
-            int32_t dy;
-        };
-
-        MoveRequest req;
-        req.playerId = myPlayerId;
-        req.dx = dx;
-        req.dy = dy;
-
-        send(serverSocket, (char*)&req, sizeof(MoveRequest), 0);
+        // The server knows which player this socket controls, so only the step is sent
+        MoveMessage move;
+        move.dx = dx;
+        move.dy = dy;
+        move.seq = nextMoveSeq++;
+
+        // Shared-memory moves never go over TCP, so the server sees them in
+        // order; if the ring is full they wait here until the next sync
+        if (sharedRoom) {
+            sharedOverflow.push_back(move);
+            flushSharedOverflow();
+            return;
+        }
+
+        uint8_t frame[WIRE_MAX_FRAME];
+        sendFrame(frame, wireEncodeMove(frame, move));
+    }
+
+    void flushSharedOverflow() {
+        while (!sharedOverflow.empty() && sharedRoom->pushMove(mySlot, myRingGeneration, sharedOverflow.front())) {
+            sharedOverflow.pop_front();
+        }
+    }
+
+    // Shared-memory mode: returns false once the server has closed the socket.
+    // Any bytes read are TCP snapshots sent before the switch and are discarded.
+    bool checkSocketOpen() {
+        char scratch[256];
+        int received = recv(serverSocket, scratch, sizeof(scratch), 0);
+        if (received == 0) {
+            return false;
+        }
+        if (received < 0) {
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+        return true;
+    }
+
+    void handleFrame(const WireFrame& frame) {
+        if (frame.type == WIRE_JOIN_REPLY) {
+            JoinReply reply;
+            if (wireDecodeJoinReply(frame, reply)) {
+                myRoomId = reply.roomId;
+                myPlayerId = reply.playerId;
+            }
+        } else if (frame.type == WIRE_STATE) {
+            // Decode over a copy so a bad frame can't leave a half-written state
+            GameState newState = localState;
+            if (wireDecodeState(frame, newState)) {
+                localState = newState;
+                haveState = true;
+
+                // Snap back to server state (correcting any wrong predictions)
+                predictedState = localState;
+            }
+        }
+    }
+
+    // Read what the socket has and apply every complete frame.
+    // Returns false if the connection was closed or sent garbage.
+    bool receiveFrames() {
+        int received = recv(serverSocket, (char*)rxBuffer + rxLength, (int)(sizeof(rxBuffer) - rxLength), 0);
+        if (received == 0) {
+            return false;
+        }
+        if (received < 0) {
+            // Nothing to read yet on a non-blocking socket is not an error
+            return WSAGetLastError() == WSAEWOULDBLOCK;
+        }
+        rxLength += received;
+
+        // Decode straight out of the receive buffer
+        size_t offset = 0;
+        while (true) {
+            WireFrame frame;
+            int consumed = wireDecodeFrame(rxBuffer + offset, rxLength - offset, frame);
+            if (consumed < 0) {
+                return false;
+            }
+            if (consumed == 0) {
+                break;
+            }
+            handleFrame(frame);
+            offset += consumed;
+        }
+
+        // Keep any partial frame for the next read
+        memmove(rxBuffer, rxBuffer + offset, rxLength - offset);
+        rxLength -= offset;
+        return true;
+    }
+
+    static bool isLocalHost(const char* host) {
+        return strcmp(host, "127.0.0.1") == 0 || strcmp(host, "localhost") == 0;
+    }
+
+    // Map the room's shared region and tell the server to stop sending snapshots over TCP
+    void attachSharedMemory(int port) {
+        for (int i = 0; i < 4; i++) {
+            if (localState.players[i].isActive && localState.players[i].id == myPlayerId) {
+                mySlot = i;
+            }
+        }
+
+        char name[64];
+        char wakeName[64];
+        sharedRoomName(name, sizeof(name), port, myRoomId);
+        sharedWakeName(wakeName, sizeof(wakeName), port);
+        std::unique_ptr<SharedRoomMapping> mapping(new SharedRoomMapping());
+        if (mySlot == -1 || !mapping->open(name, wakeName)) {
+            std::cerr << "Shared memory unavailable, using TCP" << std::endl;
+            return;
+        }
+        myRingGeneration = mapping->moveRingGeneration(mySlot);
+        sharedRoom = std::move(mapping);
+
+        uint8_t frame[WIRE_MAX_FRAME];
+        sendFrame(frame, wireEncodeAttachShared(frame));
     }
 
     Player* getMyPlayer() {
@@ -98,41 +235,48 @@ private:
     }
 
 public:
-    DSMMemory(const char* host, int port, ConsistencyMode consistencyMode) 
-        : serverSocket(INVALID_SOCKET), myPlayerId(-1), mode(consistencyMode) {
+    DSMMemory(const char* host, int port, int32_t roomId, ConsistencyMode consistencyMode,
+              bool preferSharedMemory = false)
+        : serverSocket(INVALID_SOCKET), localState(), predictedState(), myPlayerId(-1), myRoomId(-1), mode(consistencyMode),
+          nextMoveSeq(1), rxLength(0), haveState(false), lastSharedSeq(0), mySlot(-1), myRingGeneration(0),
+          syncsSinceSocketCheck(0), connected(true) {
         
         if (!connectToServer(host, port)) {
             throw std::runtime_error("Failed to connect to server");
         }
 
-        // Wait for initial state
-        std::cout << "Waiting for initial game state..." << std::endl;
-        
         // Set socket to blocking temporarily
         u_long blocking = 0;
         ioctlsocket(serverSocket, FIONBIO, &blocking);
-        
-        int received = recv(serverSocket, (char*)&localState, sizeof(GameState), 0);
-        if (received != sizeof(GameState)) {
-            throw std::runtime_error("Failed to receive initial state");
+
+        // Ask the server for a room and learn which player we are
+        JoinRequest join;
+        join.roomId = roomId;
+        uint8_t frame[WIRE_MAX_FRAME];
+        sendFrame(frame, wireEncodeJoinRequest(frame, join));
+
+        // Wait for the join reply and initial state (which includes the maze)
+        std::cout << "Waiting for initial game state..." << std::endl;
+
+        while (myPlayerId == -1 || !haveState) {
+            if (!receiveFrames()) {
+                throw std::runtime_error("Failed to join room (room full or invalid)");
+            }
         }
 
         // Set back to non-blocking
         u_long nonBlocking = 1;
         ioctlsocket(serverSocket, FIONBIO, &nonBlocking);
 
-        // Copy to predicted state
-        predictedState = localState;
-
-        // Find my player ID (the most recently activated player)
-        for (int i = 0; i < 4; i++) {
-            if (localState.players[i].isActive) {
-                myPlayerId = localState.players[i].id;
-            }
+        // Shared memory only works when the server runs on this machine
+        if (preferSharedMemory && isLocalHost(host)) {
+            attachSharedMemory(port);
         }
 
+        std::cout << "Joined Room: " << myRoomId << std::endl;
         std::cout << "Assigned Player ID: " << myPlayerId << std::endl;
         std::cout << "Consistency Mode: " << (mode == SEQUENTIAL ? "SEQUENTIAL" : "RELEASE") << std::endl;
+        std::cout << "Transport: " << (sharedRoom ? "SHARED MEMORY" : "TCP") << std::endl;
     }
 
     // Main DSM transparency function
@@ -189,15 +333,34 @@ public:
 
     // Update from server (snap back if prediction was wrong)
     void syncWithServer() {
-        GameState newState;
-        int received = recv(serverSocket, (char*)&newState, sizeof(GameState), 0);
+        if (!connected) {
+            return;
+        }
 
-        if (received == sizeof(GameState)) {
-            localState = newState;
-            
-            // Snap back to server state (correcting any wrong predictions)
-            predictedState = localState;
+        if (sharedRoom) {
+            flushSharedOverflow();
+
+            if (++syncsSinceSocketCheck >= SOCKET_CHECK_INTERVAL) {
+                syncsSinceSocketCheck = 0;
+                connected = checkSocketOpen();
+            }
+
+            // Read the latest snapshot straight from shared memory, no system call
+            GameState snapshot;
+            if (sharedRoom->readState(snapshot, lastSharedSeq)) {
+                localState = snapshot;
+
+                // Snap back to server state (correcting any wrong predictions)
+                predictedState = localState;
+            }
+            return;
         }
+
+        connected = receiveFrames();
+    }
+
+    bool isConnected() const {
+        return connected;
     }
 
     const GameState& getState() const {
@@ -208,6 +371,10 @@ public:
         return myPlayerId;
     }
 
+    int getMyRoomId() const {
+        return myRoomId;
+    }
+
     ~DSMMemory() {
         if (serverSocket != INVALID_SOCKET) {
             closesocket(serverSocket);
@@ -284,8 +451,16 @@ int main() {
 
     ConsistencyMode mode = (choice == 2) ? RELEASE : SEQUENTIAL;
 
+    std::cout << "Room number (-1 to auto-assign): ";
+    int32_t roomId;
+    std::cin >> roomId;
+
+    // DSM_TRANSPORT=shm uses shared memory when the server is on this machine
+    const char* transport = getenv("DSM_TRANSPORT");
+    bool useSharedMemory = transport && strcmp(transport, "shm") == 0;
+
     try {
-        DSMMemory dsm("127.0.0.1", 5000, mode);
+        DSMMemory dsm("127.0.0.1", 5000, roomId, mode, useSharedMemory);
 
         GameRenderer::render(dsm.getState(), dsm.getMyPlayerId());
 
@@ -293,6 +468,10 @@ int main() {
         while (running) {
             // Sync with server
             dsm.syncWithServer();
+            if (!dsm.isConnected()) {
+                std::cerr << "Lost connection to server" << std::endl;
+                break;
+            }
 
             // Handle input
             if (_kbhit()) {
@@ -1,6 +1,15 @@
+// WSAPoll() needs the Vista-level socket API (must come before any Windows header)
+#if !defined(_WIN32_WINNT) || _WIN32_WINNT < 0x0600
+#undef _WIN32_WINNT
+#define _WIN32_WINNT 0x0600
+#endif
+
 // Shared game state definitions and structures
 #include "SharedState.h"
 
+// Binary wire encoding for every message on the socket
+#include "WireCodec.h"
+
 // Console output for logging
 #include <iostream>
 
@@ -16,67 +25,253 @@
 // TCP/IP protocol definitions and utilities
 #include <ws2tcpip.h>
 
+// Per-room shared-memory regions for clients on this machine
+#include "SharedMemoryTransport.h"
+
 // Dynamic array for managing multiple client connections
 #include <vector>
 
+// Room lookup by ID and the set of rooms with free player slots
+#include <map>
+#include <set>
+
+// Owning pointers so empty rooms can be released
+#include <memory>
+
 // String manipulation functions (memset, etc.)
 #include <cstring>
 
+// Environment lookup for transport configuration
+#include <cstdlib>
 
-class AuthoritativeServer {
-private:
-    SOCKET serverSocket;
-    std::vector<SOCKET> clientSockets;
+// Join timeouts for connections that never pick a room
+#include <chrono>
+
+
+// Enough for 4096 full 4-player rooms; WSAPoll() has no fixed socket limit
+const size_t MAX_CONNECTIONS = 16384;
+
+// Connections that haven't sent a JoinRequest within this time are dropped
+const int JOIN_TIMEOUT_MS = 5000;
+
+// Unsent bytes a client may fall behind by (~1000 state updates) before it is dropped
+const size_t MAX_SEND_BACKLOG = 16 * 1024;
+
+// How often move totals are logged; single moves are only logged with DSM_LOG_MOVES=1
+const int MOVE_SUMMARY_INTERVAL_MS = 10000;
+
+struct ClientConnection;
+
+// GameRoom - one independent game instance with its own master copy.
+// Rooms are created on first join and released when the last player leaves,
+// so idle rooms cost nothing.
+struct GameRoom {
+    int roomId;
     GameState masterState;
     int nextPlayerId;
+    int playerCount;
+    std::vector<ClientConnection*> members; // Clients that receive state over TCP
+    std::unique_ptr<SharedRoomMapping> shared; // Null unless shared memory is enabled
+};
+
+// ClientConnection - a connected socket and the room/slot it joined
+struct ClientConnection {
+    SOCKET socket;
+    int roomId;      // -1 until the client's JoinRequest has been handled
+    int playerSlot;
+    uint32_t lastMoveSeq;
+    bool usesSharedMemory; // Reads state and sends moves through the room's region
+    uint32_t ringGeneration; // Stamp this client's ring entries must carry
+
+    // Bytes received but not yet decoded (at most one partial frame between reads)
+    uint8_t rxBuffer[2 * WIRE_MAX_FRAME];
+    size_t rxLength;
 
-    void initializeGameState() {
+    // Bytes the socket couldn't take yet; sent when it becomes writable
+    std::vector<uint8_t> txBuffer;
+
+    std::chrono::steady_clock::time_point connectedAt;
+
+    // Set instead of closing in place, so poll indexes stay valid until the sweep
+    bool dropped;
+};
+
+class AuthoritativeServer {
+private:
+    SOCKET serverSocket;
+    std::vector<std::unique_ptr<ClientConnection>> clients;
+    std::map<int, std::unique_ptr<GameRoom>> rooms;
+    std::set<int> openRooms; // Rooms with at least one free player slot
+    int nextRoomId;
+    int port;
+    uint32_t nextRingGeneration; // Server-wide, so a recreated room never reuses one
+    bool sharedMemoryEnabled;
+
+    // Signalled when any socket has activity (every socket is WSAEventSelect()ed to it)
+    WSAEVENT socketEvent;
+
+    // Signalled by local clients when a move lands in a ring we found empty
+    HANDLE sharedWakeEvent;
+
+    // Clients attached to shared memory, so draining rings doesn't scan every connection
+    std::vector<ClientConnection*> sharedClients;
+    bool sharedMovesPending; // A ring may still hold moves; don't wait before draining
+
+    // Console writes are slow next to a move, so the hot path only counts
+    bool logEveryMove;
+    long movesApplied;
+    long movesRejected;
+    std::chrono::steady_clock::time_point lastMoveSummary;
+
+    void initializeGameState(GameState& state) {
         // Copy maze layout into game state
         for (int i = 0; i < 10; i++) {
             for (int j = 0; j < 10; j++) {
-                masterState.grid[i][j] = MAZE_LAYOUT[i][j];
+                state.grid[i][j] = MAZE_LAYOUT[i][j];
             }
         }
 
         // Initialize all players as inactive
         for (int i = 0; i < 4; i++) {
-            masterState.players[i].id = -1;
-            masterState.players[i].x = 1;
-            masterState.players[i].y = 1;
-            masterState.players[i].isActive = false;
+            state.players[i].id = -1;
+            state.players[i].x = 1;
+            state.players[i].y = 1;
+            state.players[i].isActive = false;
+        }
+    }
+
+    GameRoom* createRoom(int roomId) {
+        std::unique_ptr<GameRoom> room(new GameRoom());
+        room->roomId = roomId;
+        room->nextPlayerId = 0;
+        room->playerCount = 0;
+        initializeGameState(room->masterState);
+
+        if (sharedMemoryEnabled) {
+            char name[64];
+            sharedRoomName(name, sizeof(name), port, roomId);
+            room->shared.reset(new SharedRoomMapping());
+            if (!room->shared->create(name, room->masterState)) {
+                std::cerr << "Shared memory unavailable for room " << roomId << ", using TCP only" << std::endl;
+                room->shared.reset();
+            }
         }
 
-        nextPlayerId = 0;
+        GameRoom* created = room.get();
+        rooms[roomId] = std::move(room);
+        openRooms.insert(roomId);
+
+        std::cout << "Room " << roomId << " created (" << rooms.size() << " active rooms)" << std::endl;
+        return created;
     }
 
-    bool isLegalMove(int x, int y) {
+    void releaseRoom(int roomId) {
+        rooms.erase(roomId);
+        openRooms.erase(roomId);
+        std::cout << "Room " << roomId << " released (" << rooms.size() << " active rooms)" << std::endl;
+    }
+
+    // Resolve a JoinRequest to a room, creating one if needed
+    GameRoom* findRoomForJoin(int32_t requestedRoomId) {
+        if (requestedRoomId == AUTO_ASSIGN_ROOM) {
+            // Fill existing rooms before opening new ones
+            if (!openRooms.empty()) {
+                return rooms[*openRooms.begin()].get();
+            }
+            while (rooms.count(nextRoomId)) {
+                nextRoomId++;
+            }
+            return createRoom(nextRoomId++);
+        }
+
+        if (requestedRoomId < 0) {
+            return nullptr;
+        }
+
+        auto it = rooms.find(requestedRoomId);
+        if (it != rooms.end()) {
+            return it->second.get();
+        }
+        return createRoom(requestedRoomId);
+    }
+
+    bool isLegalMove(const GameState& state, int x, int y) {
         // Check bounds
         if (x < 0 || x >= 10 || y < 0 || y >= 10) {
             return false;
         }
 
         // Check if position is a wall
-        char cell = masterState.grid[y][x];
+        char cell = state.grid[y][x];
         return (cell == ' '); // Only spaces are walkable
 
 
         //check if position is occupied by another player
         for (int i = 0; i < 4; i++) {
-            if (masterState.players[i].isActive && 
-                masterState.players[i].x == x && 
-                masterState.players[i].y == y) {
+            if (state.players[i].isActive && 
+                state.players[i].x == x && 
+                state.players[i].y == y) {
                 return false;
             }
         }
         return true;
     }
 
-    void broadcastState() {
-        for (SOCKET client : clientSockets) {
-            int sent = send(client, (char*)&masterState, sizeof(GameState), 0);
-            if (sent == SOCKET_ERROR) {
-                std::cerr << "Failed to broadcast to client" << std::endl;
+    // Mark a client for removal at the end of this loop iteration
+    void dropClient(ClientConnection& conn, const char* reason) {
+        if (!conn.dropped) {
+            std::cout << "Dropping client: " << reason << std::endl;
+            conn.dropped = true;
+        }
+    }
+
+    // Sockets are non-blocking, so a client that stops reading can't stall the
+    // loop; its bytes queue up here until it falls too far behind.
+    void sendFrame(ClientConnection& conn, const uint8_t* frame, size_t length) {
+        if (conn.dropped || length == 0) {
+            return;
+        }
+
+        bool wasIdle = conn.txBuffer.empty();
+        conn.txBuffer.insert(conn.txBuffer.end(), frame, frame + length);
+        if (wasIdle) {
+            flushSendBuffer(conn);
+        }
+        if (conn.txBuffer.size() > MAX_SEND_BACKLOG) {
+            dropClient(conn, "fell too far behind");
+        }
+    }
+
+    // Send until the buffer is empty or the socket is full. FD_WRITE is only
+    // signalled again after a send would block, so stopping after a partial
+    // send would leave the rest waiting for the next timeout.
+    void flushSendBuffer(ClientConnection& conn) {
+        size_t sent = 0;
+        while (sent < conn.txBuffer.size()) {
+            int result = send(conn.socket, (const char*)conn.txBuffer.data() + sent,
+                              (int)(conn.txBuffer.size() - sent), 0);
+            if (result == SOCKET_ERROR) {
+                if (WSAGetLastError() != WSAEWOULDBLOCK) {
+                    dropClient(conn, "send failed");
+                }
+                break;
             }
+            sent += result;
+        }
+        conn.txBuffer.erase(conn.txBuffer.begin(), conn.txBuffer.begin() + sent);
+    }
+
+    // Members already hold the maze, so broadcasts carry only player data
+    void broadcastState(const GameRoom& room) {
+        if (room.shared) {
+            room.shared->publishState(room.masterState);
+        }
+
+        uint8_t frame[WIRE_MAX_FRAME];
+        size_t length = wireEncodeState(frame, room.masterState, false);
+
+        for (ClientConnection* client : room.members) {
+            sendFrame(*client, frame, length);
         }
     }
 
@@ -90,104 +285,339 @@ private:
             return;
         }
 
+        if (clients.size() >= MAX_CONNECTIONS) {
+            std::cout << "Server full, rejecting connection" << std::endl;
+            closesocket(newClient);
+            return;
+        }
+
+        // Also makes the socket non-blocking
+        WSAEventSelect(newClient, socketEvent, FD_READ | FD_WRITE | FD_CLOSE);
+
+        // The room is chosen once the client's JoinRequest arrives
+        std::unique_ptr<ClientConnection> conn(new ClientConnection());
+        conn->socket = newClient;
+        conn->roomId = -1;
+        conn->playerSlot = -1;
+        conn->lastMoveSeq = 0;
+        conn->usesSharedMemory = false;
+        conn->ringGeneration = 0;
+        conn->rxLength = 0;
+        conn->connectedAt = std::chrono::steady_clock::now();
+        conn->dropped = false;
+        clients.push_back(std::move(conn));
+    }
+
+    void removeFromMembers(GameRoom& room, const ClientConnection* conn) {
+        for (size_t i = 0; i < room.members.size(); i++) {
+            if (room.members[i] == conn) {
+                room.members.erase(room.members.begin() + i);
+                break;
+            }
+        }
+    }
+
+    // Close a client's socket and free its player slot
+    void disconnectClient(size_t clientIndex) {
+        std::unique_ptr<ClientConnection> conn = std::move(clients[clientIndex]);
+        clients.erase(clients.begin() + clientIndex);
+        closesocket(conn->socket);
+        if (conn->usesSharedMemory) {
+            for (size_t i = 0; i < sharedClients.size(); i++) {
+                if (sharedClients[i] == conn.get()) {
+                    sharedClients.erase(sharedClients.begin() + i);
+                    break;
+                }
+            }
+        }
+
+        auto it = rooms.find(conn->roomId);
+        if (it == rooms.end()) {
+            return;
+        }
+
+        GameRoom& room = *it->second;
+        std::cout << "Client disconnected from room " << room.roomId << std::endl;
+
+        // Deactivate player
+        room.masterState.players[conn->playerSlot].isActive = false;
+        removeFromMembers(room, conn.get());
+        room.playerCount--;
+
+        if (room.playerCount == 0) {
+            releaseRoom(room.roomId);
+        } else {
+            openRooms.insert(room.roomId);
+            broadcastState(room);
+        }
+    }
+
+    // Close dropped clients and any that never joined a room in time.
+    // Clients dropped by the broadcasts this triggers are closed on the next pass.
+    void removeDroppedClients() {
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < clients.size(); ) {
+            ClientConnection& conn = *clients[i];
+            if (conn.roomId == -1 &&
+                now - conn.connectedAt > std::chrono::milliseconds(JOIN_TIMEOUT_MS)) {
+                dropClient(conn, "no join request before timeout");
+            }
+
+            if (conn.dropped) {
+                disconnectClient(i);
+            } else {
+                i++;
+            }
+        }
+    }
+
+    void handleJoinRequest(ClientConnection& conn, const JoinRequest& req) {
+        GameRoom* room = findRoomForJoin(req.roomId);
+        if (!room) {
+            std::cout << "Invalid room ID " << req.roomId << ", rejecting connection" << std::endl;
+            dropClient(conn, "invalid room");
+            return;
+        }
+
         // Find available player slot
         int playerSlot = -1;
         for (int i = 0; i < 4; i++) {
-            if (!masterState.players[i].isActive) {
+            if (!room->masterState.players[i].isActive) {
                 playerSlot = i;
                 break;
             }
         }
 
         if (playerSlot == -1) {
-            std::cout << "Server full, rejecting connection" << std::endl;
-            closesocket(newClient);
+            std::cout << "Room " << room->roomId << " full, rejecting connection" << std::endl;
+            dropClient(conn, "room full");
             return;
         }
 
         // Activate player
-        masterState.players[playerSlot].id = nextPlayerId++;
-        masterState.players[playerSlot].x = 1 + playerSlot * 2; // Spread starting positions
-        masterState.players[playerSlot].y = 1;
-        masterState.players[playerSlot].isActive = true;
+        Player& player = room->masterState.players[playerSlot];
+        player.id = room->nextPlayerId++;
+        player.x = 1 + playerSlot * 2; // Spread starting positions
+        player.y = 1;
+        player.isActive = true;
+
+        room->playerCount++;
+        if (room->playerCount == 4) {
+            openRooms.erase(room->roomId);
+        }
+
+        conn.roomId = room->roomId;
+        conn.playerSlot = playerSlot;
+
+        // Drop anything a previous player left in this slot's ring, and
+        // ignore whatever it queues there before noticing it was dropped
+        conn.ringGeneration = nextRingGeneration++;
+        if (room->shared) {
+            room->shared->resetMoveRing(playerSlot, conn.ringGeneration);
+        }
+
+        std::cout << "Client joined room " << room->roomId << ". Assigned Player " << playerSlot
+                  << " (ID: " << player.id << ")" << std::endl;
+
+        // Show the new player to the rest of the room
+        broadcastState(*room);
 
-        clientSockets.push_back(newClient);
+        // Tell the client who it is, then send the full state including the maze
+        JoinReply reply;
+        reply.roomId = room->roomId;
+        reply.playerId = player.id;
 
-        std::cout << "Client connected. Assigned Player " << playerSlot 
-                  << " (ID: " << masterState.players[playerSlot].id << ")" << std::endl;
+        uint8_t frame[WIRE_MAX_FRAME];
+        sendFrame(conn, frame, wireEncodeJoinReply(frame, reply));
+        sendFrame(conn, frame, wireEncodeState(frame, room->masterState, true));
 
-        // Send initial state to all clients
-        broadcastState();
+        room->members.push_back(&conn);
     }
 
-    void handleClientData(SOCKET clientSocket, int clientIndex) {
-        // Receive move request: playerId, dx, dy
-        struct MoveRequest {
-            int32_t playerId;
-            int32_t dx;
-            int32_t dy;
-        };
+    void handleMove(ClientConnection& conn, const MoveMessage& move) {
+        GameRoom& room = *rooms[conn.roomId];
 
-        MoveRequest req;
-        int received = recv(clientSocket, (char*)&req, sizeof(MoveRequest), 0);
+        // TCP keeps moves ordered; anything older than the last one is a replay
+        if (move.seq <= conn.lastMoveSeq) {
+            movesRejected++;
+            if (logEveryMove) {
+                std::cerr << "Stale move " << move.seq << " in room " << room.roomId << std::endl;
+            }
+            return;
+        }
+        conn.lastMoveSeq = move.seq;
 
-        if (received <= 0) {
-            // Client disconnected
-            std::cout << "Client disconnected" << std::endl;
+        // A client may only move the player it was assigned at join
+        Player* player = &room.masterState.players[conn.playerSlot];
 
-            // Deactivate player
-            for (int i = 0; i < 4; i++) {
-                if (masterState.players[i].id == req.playerId || 
-                    (received == 0 && i == clientIndex)) {
-                    masterState.players[i].isActive = false;
-                    break;
-                }
+        // Calculate new position
+        int newX = player->x + move.dx;
+        int newY = player->y + move.dy;
+
+        // Validate move
+        if (isLegalMove(room.masterState, newX, newY)) {
+            player->x = newX;
+            player->y = newY;
+            movesApplied++;
+            if (logEveryMove) {
+                std::cout << "Room " << room.roomId << ": Player " << player->id
+                          << " moved to (" << newX << ", " << newY << ")" << std::endl;
+            }
+        } else {
+            movesRejected++;
+            if (logEveryMove) {
+                std::cout << "Room " << room.roomId << ": Player " << player->id
+                          << " attempted illegal move to (" << newX << ", " << newY << ") - REJECTED" << std::endl;
             }
+        }
+
+        // Broadcast updated state to everyone in the room
+        broadcastState(room);
+    }
+
+    // The client now reads snapshots from the region, so stop sending them over TCP
+    void attachSharedMemory(GameRoom& room, ClientConnection& conn) {
+        removeFromMembers(room, &conn);
+        conn.usesSharedMemory = true;
+        sharedClients.push_back(&conn);
+
+        // Moves pushed before this message arrived didn't wake us for this client
+        sharedMovesPending = true;
+
+        std::cout << "Room " << room.roomId << ": Player " << room.masterState.players[conn.playerSlot].id
+                  << " switched to shared memory" << std::endl;
+    }
 
-            closesocket(clientSocket);
-            clientSockets.erase(clientSockets.begin() + clientIndex);
-            broadcastState();
+    // At most one ring's worth per call, so a client refilling its ring as
+    // fast as it drains can't hold the loop.
+    // Returns true if the ring may still hold moves.
+    bool drainSharedMoves(ClientConnection& conn) {
+        SharedRoomMapping& shared = *rooms[conn.roomId]->shared;
+        MoveMessage move;
+        for (uint32_t i = 0; i < SHARED_RING_CAPACITY; i++) {
+            SharedPopResult result = shared.popMove(conn.playerSlot, conn.ringGeneration,
+                                                    conn.lastMoveSeq + 1, move);
+            if (result == SHARED_RING_EMPTY) {
+                return false;
+            }
+            if (result == SHARED_RING_CORRUPT) {
+                dropClient(conn, "corrupt shared-memory move ring");
+                return false;
+            }
+            if (result == SHARED_RING_MOVE) {
+                handleMove(conn, move);
+            }
+        }
+        return true;
+    }
+
+    // Drain the move rings of every shared-memory client
+    void pollSharedMoves() {
+        sharedMovesPending = false;
+        for (ClientConnection* conn : sharedClients) {
+            if (!conn->dropped && drainSharedMoves(*conn)) {
+                sharedMovesPending = true;
+            }
+        }
+    }
+
+    // One line per interval instead of one per move
+    void logMoveSummary() {
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - lastMoveSummary).count();
+        if (seconds * 1000 < MOVE_SUMMARY_INTERVAL_MS) {
             return;
         }
 
-        // Find player
-        Player* player = nullptr;
-        for (int i = 0; i < 4; i++) {
-            if (masterState.players[i].id == req.playerId && masterState.players[i].isActive) {
-                player = &masterState.players[i];
-                break;
+        if (movesApplied + movesRejected > 0) {
+            std::cout << "Moves: " << movesApplied << " applied, " << movesRejected << " rejected in "
+                      << (int)seconds << "s (" << (long)((movesApplied + movesRejected) / seconds)
+                      << "/s) across " << rooms.size() << " rooms" << std::endl;
+        }
+        movesApplied = 0;
+        movesRejected = 0;
+        lastMoveSummary = now;
+    }
+
+    void handleMessage(ClientConnection& conn, const WireFrame& frame) {
+        if (frame.type == WIRE_JOIN_REQUEST && conn.roomId == -1) {
+            JoinRequest req;
+            if (wireDecodeJoinRequest(frame, req)) {
+                handleJoinRequest(conn, req);
+                return;
+            }
+        } else if (frame.type == WIRE_MOVE && conn.roomId != -1 && !conn.usesSharedMemory) {
+            // Shared-memory clients send every move through their ring, so
+            // the two transports can never reorder each other's moves
+            MoveMessage move;
+            if (wireDecodeMove(frame, move)) {
+                handleMove(conn, move);
+                return;
+            }
+        } else if (frame.type == WIRE_ATTACH_SHARED && conn.roomId != -1 && !conn.usesSharedMemory) {
+            GameRoom& room = *rooms[conn.roomId];
+            if (room.shared) {
+                attachSharedMemory(room, conn);
+                return;
             }
         }
 
-        if (!player) {
-            std::cerr << "Invalid player ID: " << req.playerId << std::endl;
+        dropClient(conn, "unexpected or malformed message");
+    }
+
+    void handleClientData(ClientConnection& conn) {
+        int received = recv(conn.socket, (char*)conn.rxBuffer + conn.rxLength,
+                            (int)(sizeof(conn.rxBuffer) - conn.rxLength), 0);
+
+        if (received == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK) {
+            return;
+        }
+        if (received <= 0) {
+            // Client disconnected
+            if (conn.roomId == -1) {
+                std::cout << "Client disconnected before joining a room" << std::endl;
+            }
+            conn.dropped = true;
             return;
         }
+        conn.rxLength += received;
 
-        // Calculate new position
-        int newX = player->x + req.dx;
-        int newY = player->y + req.dy;
+        // Decode every complete frame straight out of the receive buffer
+        size_t offset = 0;
+        while (true) {
+            WireFrame frame;
+            int consumed = wireDecodeFrame(conn.rxBuffer + offset, conn.rxLength - offset, frame);
+            if (consumed == 0) {
+                break;
+            }
+            if (consumed < 0) {
+                dropClient(conn, "malformed frame");
+                return;
+            }
+            offset += consumed;
 
-        // Validate move
-        if (isLegalMove(newX, newY)) {
-            player->x = newX;
-            player->y = newY;
-            std::cout << "Player " << req.playerId << " moved to (" << newX << ", " << newY << ")" << std::endl;
-        } else {
-            std::cout << "Player " << req.playerId << " attempted illegal move to (" 
-                      << newX << ", " << newY << ") - REJECTED" << std::endl;
+            handleMessage(conn, frame);
+            if (conn.dropped) {
+                return;
+            }
         }
 
-        // Broadcast updated state to all clients
-        broadcastState();
+        // Keep any partial frame for the next read
+        memmove(conn.rxBuffer, conn.rxBuffer + offset, conn.rxLength - offset);
+        conn.rxLength -= offset;
     }
 
 public:
-    AuthoritativeServer() : serverSocket(INVALID_SOCKET), nextPlayerId(0) {
-        initializeGameState();
+    explicit AuthoritativeServer(bool useSharedMemory = false, bool logMoves = false)
+        : serverSocket(INVALID_SOCKET), nextRoomId(0), port(0), nextRingGeneration(1),
+          sharedMemoryEnabled(useSharedMemory), socketEvent(WSA_INVALID_EVENT),
+          sharedWakeEvent(NULL), sharedMovesPending(false), logEveryMove(logMoves),
+          movesApplied(0), movesRejected(0), lastMoveSummary(std::chrono::steady_clock::now()) {
     }
 
-    bool initialize(int port) {
+    bool initialize(int listenPort) {
+        port = listenPort;
+
         WSADATA wsaData;
         if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
             std::cerr << "WSAStartup failed" << std::endl;
@@ -220,6 +650,27 @@ public:
             return false;
         }
 
+        // WSAPoll() can't wait on the shared-memory wake event, so sockets
+        // report activity through an event too and the loop waits on both
+        socketEvent = WSACreateEvent();
+        if (socketEvent == WSA_INVALID_EVENT ||
+            WSAEventSelect(serverSocket, socketEvent, FD_ACCEPT) == SOCKET_ERROR) {
+            std::cerr << "Socket event setup failed" << std::endl;
+            closesocket(serverSocket);
+            WSACleanup();
+            return false;
+        }
+
+        if (sharedMemoryEnabled) {
+            char wakeName[64];
+            sharedWakeName(wakeName, sizeof(wakeName), port);
+            sharedWakeEvent = CreateEventA(NULL, FALSE, FALSE, wakeName);
+            if (!sharedWakeEvent) {
+                std::cerr << "Shared-memory wake event unavailable, using TCP only" << std::endl;
+                sharedMemoryEnabled = false;
+            }
+        }
+
         std::cout << "Server initialized on port " << port << std::endl;
         return true;
     }
@@ -227,64 +678,106 @@ public:
     void run() {
         std::cout << "Server running. Waiting for clients..." << std::endl;
 
+        std::vector<WSAPOLLFD> pollSet;
         while (true) {
-            fd_set readSet;
-            FD_ZERO(&readSet);
-            FD_SET(serverSocket, &readSet);
-
-            SOCKET maxSocket = serverSocket;
-            for (SOCKET client : clientSockets) {
-                FD_SET(client, &readSet);
-                if (client > maxSocket) {
-                    maxSocket = client;
+            // pollSet[0] is the listener; pollSet[i + 1] belongs to clients[i]
+            pollSet.clear();
+            WSAPOLLFD listener = {};
+            listener.fd = serverSocket;
+            listener.events = POLLRDNORM;
+            pollSet.push_back(listener);
+
+            for (const std::unique_ptr<ClientConnection>& client : clients) {
+                WSAPOLLFD entry = {};
+                entry.fd = client->socket;
+                entry.events = POLLRDNORM;
+                if (!client->txBuffer.empty()) {
+                    entry.events |= POLLWRNORM;
                 }
+                pollSet.push_back(entry);
             }
 
-            // Use select() to handle multiple clients without threads
-            timeval timeout;
-            timeout.tv_sec = 1;
-            timeout.tv_usec = 0;
+            // Sleep until a socket has activity or a local client queues a move.
+            // Both are events, so neither waits for a timer tick; the timeout
+            // only drives the join-timeout sweep.
+            if (!sharedMovesPending) {
+                WSAEVENT waitEvents[2] = { socketEvent, sharedWakeEvent };
+                DWORD eventCount = sharedWakeEvent ? 2 : 1;
+                if (WSAWaitForMultipleEvents(eventCount, waitEvents, FALSE, 1000, FALSE) == WSA_WAIT_FAILED) {
+                    std::cerr << "Wait error" << std::endl;
+                    break;
+                }
+            }
 
-            int activity = select(maxSocket + 1, &readSet, nullptr, nullptr, &timeout);
+            // Reset before polling, so activity during this pass wakes the next wait.
+            // Then use WSAPoll() to find which of every room's clients are ready.
+            WSAResetEvent(socketEvent);
+            int activity = WSAPoll(pollSet.data(), (ULONG)pollSet.size(), 0);
 
             if (activity == SOCKET_ERROR) {
-                std::cerr << "Select error" << std::endl;
+                std::cerr << "Poll error" << std::endl;
                 break;
             }
 
+            // Clients are only removed in the sweep below, so indexes stay valid here
+            size_t polledClients = pollSet.size() - 1;
+            for (size_t i = 0; i < polledClients; i++) {
+                ClientConnection& conn = *clients[i];
+                short events = pollSet[i + 1].revents;
+
+                // recv() reports hang-ups and errors, so route them through it
+                if (events & (POLLRDNORM | POLLHUP | POLLERR | POLLNVAL)) {
+                    handleClientData(conn);
+                }
+                if ((events & POLLWRNORM) && !conn.dropped) {
+                    flushSendBuffer(conn);
+                }
+            }
+
             // Check for new connections
-            if (FD_ISSET(serverSocket, &readSet)) {
+            if (pollSet[0].revents & POLLRDNORM) {
                 handleNewConnection();
             }
 
-            // Check for client data
-            for (int i = 0; i < clientSockets.size(); ) {
-                if (FD_ISSET(clientSockets[i], &readSet)) {
-                    handleClientData(clientSockets[i], i);
-                    // Don't increment i if client was removed
-                    if (i < clientSockets.size() && FD_ISSET(clientSockets[i], &readSet)) {
-                        i++;
-                    }
-                } else {
-                    i++;
-                }
+            if (!sharedClients.empty()) {
+                pollSharedMoves();
             }
+
+            removeDroppedClients();
+            logMoveSummary();
         }
     }
 
     ~AuthoritativeServer() {
-        for (SOCKET client : clientSockets) {
-            closesocket(client);
+        for (const std::unique_ptr<ClientConnection>& client : clients) {
+            closesocket(client->socket);
         }
         if (serverSocket != INVALID_SOCKET) {
             closesocket(serverSocket);
         }
+        if (socketEvent != WSA_INVALID_EVENT) {
+            WSACloseEvent(socketEvent);
+        }
+        if (sharedWakeEvent) {
+            CloseHandle(sharedWakeEvent);
+        }
         WSACleanup();
     }
 };
 
 int main() {
-    AuthoritativeServer server;
+    // DSM_TRANSPORT=shm lets clients on this machine use shared memory
+    const char* transport = getenv("DSM_TRANSPORT");
+    bool useSharedMemory = transport && strcmp(transport, "shm") == 0;
+
+    // DSM_LOG_MOVES=1 logs every move, which caps throughput at console speed
+    const char* logMoves = getenv("DSM_LOG_MOVES");
+    bool logEveryMove = logMoves && strcmp(logMoves, "1") == 0;
+
+    AuthoritativeServer server(useSharedMemory, logEveryMove);
+    if (useSharedMemory) {
+        std::cout << "Shared-memory transport enabled for local clients" << std::endl;
+    }
     
     if (!server.initialize(5000)) {
         std::cerr << "Failed to initialize server" << std::endl;